@@ -2,9 +2,11 @@
 #include <vector>
 #include <string>
 #include <unordered_map>
+#include <map>
 #include <stdexcept>
 #include <memory>
 #include <random>
+#include <cstdint>
 
 class Currency {
 protected:
@@ -21,11 +23,12 @@ public:
     virtual std::string makeReport(double amount, const std::string& country) const = 0;
     virtual bool isStable() const = 0;
     virtual bool canBeUsedIn(const std::string& country) const = 0;
-    std::string getCode() const;
-    std::string getSymbol() const;
-    std::string getType() const;
+    const std::string& getCode() const;
+    const std::string& getSymbol() const;
+    const std::string& getType() const;
     double getRate() const;
     double getTaxRate() const;
+    void setRate(double _rate);
 };
 
 class CryptoCurrency : public Currency {
@@ -42,6 +45,7 @@ public:
     bool isStable() const override;
     bool canBeUsedIn(const std::string& country) const override;
     double getVolatility() const;
+    const std::vector<std::string>& getAllowedCountries() const;
 };
 
 class FiatCurrency : public Currency {
@@ -58,6 +62,7 @@ public:
     bool isStable() const override;
     bool canBeUsedIn(const std::string& country) const override;
     double getInflationRate() const;
+    const std::vector<std::string>& getAllowedCountries() const;
 };
 
 class MagicCurrency : public Currency {
@@ -78,19 +83,50 @@ public:
     int getRarityLevel() const;
     std::string getIncantation() const;
     std::string getRealmOrigin() const;
+    static void seed(uint32_t value);
 };
 
+struct RateUpdate {
+    std::string code;
+    double rate;
+    int64_t timestamp;
+};
+
+class Portfolio;
+class TraceRecorder;
+
 class CurrencyConverter {
 private:
     std::unordered_map<std::string, std::shared_ptr<Currency>> currencies;
+    std::map<std::pair<std::string, std::string>, Currency*> orderedIndex;
+    std::map<std::string, Currency*> codeIndex;
+    std::unordered_map<std::string, std::vector<std::string>> typoIndex;
+    std::unordered_map<const Currency*, std::vector<Portfolio*>> dependents;
+    std::shared_ptr<TraceRecorder> recorder;
+    void indexTypos(const std::string& code);
+    double convertUntraced(const std::string& fromCode, const std::string& toCode, double amount) const;
+    std::string reportUntraced(const std::string& code, double amount, const std::string& country) const;
+    friend class Portfolio;
+    void trackDependency(const Currency* currency, Portfolio* portfolio);
+    void dropDependency(const Currency* currency, Portfolio* portfolio);
+    void rebindDependents(const Currency* previous, const std::shared_ptr<Currency>& replacement);
+    void notifyRateChanged(const Currency* currency);
 public:
     CurrencyConverter();
     CurrencyConverter(const CurrencyConverter&) = delete;
     CurrencyConverter& operator=(const CurrencyConverter&) = delete;
     void addCurrency(const std::shared_ptr<Currency>& currency);
     std::shared_ptr<Currency> getCurrency(const std::string& code) const;
+    const std::unordered_map<std::string, std::shared_ptr<Currency>>& getAllCurrencies() const;
     double convert(const std::string& fromCode, const std::string& toCode, double amount) const;
     std::string getReport(const std::string& code, double amount, const std::string& country) const;
     void fluctuateAll();
+    size_t applyRateUpdates(const std::vector<RateUpdate>& updates);
+    size_t listCurrencies(const Currency** out, size_t capacity, const std::string& typeFilter = "",
+                          const std::string& afterCode = "") const;
+    size_t findCurrencies(const std::string& prefix, const Currency** out, size_t capacity,
+                          bool tolerateTypo = false) const;
     void listAllCurrencies() const;
+    void setTraceRecorder(const std::shared_ptr<TraceRecorder>& _recorder);
+    std::shared_ptr<TraceRecorder> getTraceRecorder() const;
 };
\ No newline at end of file
@@ -2,11 +2,37 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <istream>
+#include <functional>
+#include <cstdint>
 #include "currency.h"
 
+enum class CurrencyKind {
+    Fiat,
+    Crypto,
+    Magic
+};
+
+struct LoadProgress {
+    uint64_t bytes = 0;
+    uint64_t records = 0;
+    uint64_t errors = 0;
+};
+
 std::vector<std::shared_ptr<FiatCurrency>> loadFiatCurrencies(const std::string& filename);
 std::vector<std::shared_ptr<CryptoCurrency>> loadCryptoCurrencies(const std::string& filename);
 std::vector<std::shared_ptr<MagicCurrency>> loadMagicCurrencies(const std::string& filename);
 
+LoadProgress streamCurrencies(CurrencyKind kind, std::istream& in, CurrencyConverter& converter,
+                              const std::function<void(const LoadProgress&)>& onProgress = nullptr,
+                              size_t chunkSize = 64 * 1024);
+LoadProgress streamCurrencies(CurrencyKind kind, int fd, CurrencyConverter& converter,
+                              const std::function<void(const LoadProgress&)>& onProgress = nullptr,
+                              size_t chunkSize = 64 * 1024);
+
+std::shared_ptr<FiatCurrency> parseFiatLine(const std::string& line);
+std::shared_ptr<CryptoCurrency> parseCryptoLine(const std::string& line);
+std::shared_ptr<MagicCurrency> parseMagicLine(const std::string& line);
+
 std::vector<std::string> splitCSVLine(const std::string& line, char delimiter = ',');
 std::vector<std::string> splitCountries(const std::string& countriesStr);
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include "currency.h"
+
+// Positions valued in a base currency, net of the liquidation tax or fee. The
+// portfolio registers with its converter, which re-prices only the positions
+// whose rates changed; it must not outlive the converter.
+class Portfolio {
+private:
+    struct Position {
+        std::shared_ptr<Currency> currency;
+        double amount;
+        double netAmount;
+        double valueInUSD;
+    };
+    CurrencyConverter& converter;
+    std::shared_ptr<Currency> base;
+    std::vector<Position> positions;
+    std::unordered_map<const Currency*, size_t> positionOf;
+    double totalInUSD;
+    friend class CurrencyConverter;
+    void onRateChanged(const Currency* currency);
+    void rebindCurrency(const Currency* previous, const std::shared_ptr<Currency>& replacement);
+    void reprice(Position& position);
+public:
+    Portfolio(CurrencyConverter& _converter, const std::string& baseCode);
+    Portfolio(const Portfolio&) = delete;
+    Portfolio& operator=(const Portfolio&) = delete;
+    ~Portfolio();
+    void addPosition(const std::string& code, double amount);
+    double getPosition(const std::string& code) const;
+    size_t getPositionCount() const;
+    std::string getBaseCode() const;
+    double getTotalValue() const;
+    double revalueAll();
+};
@@ -0,0 +1,59 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <unordered_map>
+#include "currency.h"
+
+struct RateFeedStats {
+    uint64_t bytesRead = 0;
+    uint64_t records = 0;
+    uint64_t malformed = 0;
+    uint64_t coalesced = 0;
+    uint64_t stale = 0;
+    uint64_t unknown = 0;
+    uint64_t batches = 0;
+    uint64_t applied = 0;
+    double recordsPerSecond = 0;
+    std::chrono::microseconds lastApplyLag{0};
+    std::chrono::microseconds maxApplyLag{0};
+};
+
+// Ingests "CODE,RATE,TIMESTAMP" lines from a pipe, socket or append-only journal
+// and applies them to a CurrencyConverter in coalesced batches. Only the newest update
+// (by timestamp) per currency is applied; ticks older than one already applied are
+// dropped.
+class RateFeed {
+private:
+    int fd;
+    CurrencyConverter& converter;
+    size_t maxBatchSize;
+    std::chrono::microseconds batchWindow;
+    std::vector<char> buffer;
+    size_t buffered;
+    bool skippingLine;
+    std::string code;
+    std::unordered_map<std::string, size_t> slotOf;
+    std::vector<RateUpdate> slots;
+    std::vector<char> pending;
+    std::vector<size_t> touched;
+    std::vector<RateUpdate> batch;
+    std::chrono::steady_clock::time_point started, batchStarted;
+    RateFeedStats stats;
+    void consume();
+    void parseLine(const char* begin, const char* end);
+    void flushIfDue();
+public:
+    RateFeed(int _fd, CurrencyConverter& _converter, size_t _maxBatchSize = 1024,
+             std::chrono::microseconds _batchWindow = std::chrono::milliseconds(1),
+             size_t bufferSize = 64 * 1024);
+    RateFeed(const RateFeed&) = delete;
+    RateFeed& operator=(const RateFeed&) = delete;
+    size_t poll();
+    size_t ingest(const char* data, size_t size);
+    size_t flush();
+    size_t getPendingCount() const;
+    RateFeedStats getStats() const;
+};
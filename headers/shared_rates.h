@@ -0,0 +1,62 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <unordered_map>
+#include "currency.h"
+
+struct SharedRateHeader;
+struct SharedRateSlot;
+
+// Publishes currency rates into a POSIX shared-memory segment. Every code gets a
+// fixed slot (its interned ID) for the lifetime of the segment, and each slot is
+// guarded by its own seqlock so readers never block the publisher.
+class SharedRatePublisher {
+private:
+    std::string name;
+    uint32_t capacity;
+    void* mapping;
+    size_t mappingSize;
+    SharedRateHeader* header;
+    SharedRateSlot* slots;
+    std::unordered_map<std::string, uint32_t> ids;
+public:
+    SharedRatePublisher(const std::string& _name, uint32_t _capacity);
+    SharedRatePublisher(const SharedRatePublisher&) = delete;
+    SharedRatePublisher& operator=(const SharedRatePublisher&) = delete;
+    ~SharedRatePublisher();
+    uint32_t publish(const std::string& code, double rate);
+    void publishAll(const CurrencyConverter& converter);
+    uint64_t getGeneration() const;
+    uint32_t getCapacity() const;
+    static void remove(const std::string& name);
+};
+
+// Read-only view over a segment owned by a SharedRatePublisher. Lookups only touch
+// the mapped memory; the segment is remapped when the publisher recreates it. Only
+// rates are shared, so reports and listings still need a full CurrencyConverter.
+class SharedRateView {
+private:
+    std::string name;
+    mutable void* mapping;
+    mutable size_t mappingSize;
+    mutable const SharedRateHeader* header;
+    mutable const SharedRateSlot* slots;
+    mutable uint64_t generation;
+    mutable uint32_t indexedCount;
+    mutable std::unordered_map<std::string, uint32_t> ids;
+    void attach() const;
+    void detach() const;
+    void refresh() const;
+public:
+    explicit SharedRateView(const std::string& _name);
+    SharedRateView(const SharedRateView&) = delete;
+    SharedRateView& operator=(const SharedRateView&) = delete;
+    ~SharedRateView();
+    uint32_t getId(const std::string& code) const;
+    double getRateById(uint32_t id, uint64_t expectedGeneration) const;
+    double getRate(const std::string& code) const;
+    double convert(const std::string& fromCode, const std::string& toCode, double amount) const;
+    size_t size() const;
+    uint64_t getGeneration() const;
+};
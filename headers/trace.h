@@ -0,0 +1,65 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <fstream>
+#include <random>
+#include <chrono>
+#include <cstdint>
+#include "currency.h"
+
+enum class TraceOp : uint8_t {
+    AddCurrency = 1,
+    Convert = 2,
+    Report = 3,
+    FluctuateAll = 4,
+    RateUpdates = 5
+};
+
+enum class ReplaySpeed {
+    Original,
+    Maximum
+};
+
+struct ReplayReport {
+    uint64_t operations = 0;
+    uint64_t mismatches = 0;
+    double seconds = 0;
+    double operationsPerSecond = 0;
+    std::chrono::nanoseconds p50{0};
+    std::chrono::nanoseconds p90{0};
+    std::chrono::nanoseconds p99{0};
+    std::chrono::nanoseconds max{0};
+};
+
+// Writes a compact binary trace of everything a CurrencyConverter served. Calls that
+// draw from MagicCurrency's RNG reseed it first and log the seed, so a replay makes
+// the same draws.
+class TraceRecorder {
+private:
+    std::ofstream out;
+    std::mt19937 seeds;
+    std::chrono::steady_clock::time_point started;
+    uint64_t recordCount;
+    void writeRecordHeader(TraceOp op, uint64_t start, uint64_t latency);
+    void writeString(const std::string& value);
+    template <typename T> void writeValue(const T& value);
+public:
+    explicit TraceRecorder(const std::string& filename);
+    TraceRecorder(const TraceRecorder&) = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+    uint64_t now() const;
+    uint32_t nextSeed();
+    void recordAddCurrency(const Currency& currency, uint64_t start, uint64_t latency);
+    void recordConvert(const std::string& fromCode, const std::string& toCode, double amount,
+                       bool ok, double result, uint64_t start, uint64_t latency);
+    void recordReport(const std::string& code, double amount, const std::string& country, uint32_t seed,
+                      bool ok, const std::string& report, uint64_t start, uint64_t latency);
+    void recordFluctuateAll(uint32_t seed, uint64_t ratesChecksum, uint64_t start, uint64_t latency);
+    void recordRateUpdates(const std::vector<RateUpdate>& updates, size_t applied, uint64_t start, uint64_t latency);
+    void flush();
+    uint64_t getRecordCount() const;
+};
+
+uint64_t traceChecksum(const std::string& value);
+uint64_t traceRatesChecksum(const CurrencyConverter& converter);
+ReplayReport replayTrace(const std::string& filename, CurrencyConverter& converter, ReplaySpeed speed);
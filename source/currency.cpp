@@ -1,21 +1,29 @@
 #include "currency.h"
+#include "portfolio.h"
+#include "trace.h"
 #include "text_formatting.h"
 #include <sstream>
 #include <iomanip>
 #include <algorithm>
 #include <iostream>
+#include <string_view>
 
 // --- Currency base class ---
 Currency::Currency(const std::string& _code, const std::string& _symbol, 
                    const std::string& _type, const double _rate, const double _taxRate)
     : code(_code), symbol(_symbol), type(_type), rate(_rate), taxRate(_taxRate) {}
 
-std::string Currency::getCode() const { return code; }
-std::string Currency::getSymbol() const { return symbol; }
-std::string Currency::getType() const { return type; }
+const std::string& Currency::getCode() const { return code; }
+const std::string& Currency::getSymbol() const { return symbol; }
+const std::string& Currency::getType() const { return type; }
 double Currency::getRate() const { return rate; }
 double Currency::getTaxRate() const { return taxRate; }
 
+void Currency::setRate(const double _rate) {
+    if (!(_rate > 0)) throw std::runtime_error("Rate for '" + code + "' must be positive.");
+    rate = _rate;
+}
+
 // --- CryptoCurrency ---
 CryptoCurrency::CryptoCurrency(const std::string& _code, const std::string& _symbol,
     const double _rate, const double _taxRate, double _volatility,
@@ -65,6 +73,7 @@ bool CryptoCurrency::canBeUsedIn(const std::string& country) const {
 }
 
 double CryptoCurrency::getVolatility() const { return volatility; }
+const std::vector<std::string>& CryptoCurrency::getAllowedCountries() const { return allowedCountries; }
 
 // --- FiatCurrency ---
 FiatCurrency::FiatCurrency(const std::string& _code, const std::string& _symbol,
@@ -111,6 +120,7 @@ bool FiatCurrency::canBeUsedIn(const std::string& country) const {
 }
 
 double FiatCurrency::getInflationRate() const { return inflationRate; }
+const std::vector<std::string>& FiatCurrency::getAllowedCountries() const { return allowedCountries; }
 
 // --- MagicCurrency ---
 MagicCurrency::MagicCurrency(const std::string& _code, const std::string& _symbol,
@@ -176,12 +186,39 @@ bool MagicCurrency::canBeUsedIn(const std::string& country) const {
 int MagicCurrency::getRarityLevel() const { return rarityLevel; }
 std::string MagicCurrency::getIncantation() const { return incantation; }
 std::string MagicCurrency::getRealmOrigin() const { return realmOrigin; }
+void MagicCurrency::seed(uint32_t value) { gen.seed(value); }
 
 // --- CurrencyConverter ---
 CurrencyConverter::CurrencyConverter() = default;
 
 void CurrencyConverter::addCurrency(const std::shared_ptr<Currency>& currency) {
-    currencies[normalizeCode(currency->getCode())] = currency;
+    uint64_t start = recorder ? recorder->now() : 0;
+    std::string key = normalizeCode(currency->getCode());
+    auto& slot = currencies[key];
+    std::shared_ptr<Currency> previous = slot;
+    if (previous) orderedIndex.erase({normalizeCode(previous->getType()), key});
+    else indexTypos(key);
+    slot = currency;
+    orderedIndex[{normalizeCode(currency->getType()), key}] = currency.get();
+    codeIndex[key] = currency.get();
+    if (previous && previous != currency) rebindDependents(previous.get(), currency);
+    if (recorder) recorder->recordAddCurrency(*currency, start, recorder->now() - start);
+}
+
+// Every prefix of the code and every single-character deletion of those prefixes
+// points back at the code, so a query within one edit of a prefix shares a key.
+void CurrencyConverter::indexTypos(const std::string& code) {
+    for (size_t length = 1; length <= code.size(); length++) {
+        std::string prefix = code.substr(0, length);
+        auto& exact = typoIndex[prefix];
+        if (exact.empty() || exact.back() != code) exact.push_back(code);
+        if (length < 2) continue;
+        for (size_t skip = 0; skip < length; skip++) {
+            std::string deletion = prefix.substr(0, skip) + prefix.substr(skip + 1);
+            auto& codes = typoIndex[deletion];
+            if (codes.empty() || codes.back() != code) codes.push_back(code);
+        }
+    }
 }
 
 std::shared_ptr<Currency> CurrencyConverter::getCurrency(const std::string& code) const {
@@ -190,7 +227,24 @@ std::shared_ptr<Currency> CurrencyConverter::getCurrency(const std::string& code
     return it->second;
 }
 
+const std::unordered_map<std::string, std::shared_ptr<Currency>>& CurrencyConverter::getAllCurrencies() const {
+    return currencies;
+}
+
 double CurrencyConverter::convert(const std::string& fromCode, const std::string& toCode, double amount) const {
+    if (!recorder) return convertUntraced(fromCode, toCode, amount);
+    uint64_t start = recorder->now();
+    try {
+        double converted = convertUntraced(fromCode, toCode, amount);
+        recorder->recordConvert(fromCode, toCode, amount, true, converted, start, recorder->now() - start);
+        return converted;
+    } catch (const std::exception&) {
+        recorder->recordConvert(fromCode, toCode, amount, false, 0, start, recorder->now() - start);
+        throw;
+    }
+}
+
+double CurrencyConverter::convertUntraced(const std::string& fromCode, const std::string& toCode, double amount) const {
     auto fromIt = currencies.find(normalizeCode(fromCode));
     auto toIt = currencies.find(normalizeCode(toCode));
 
@@ -203,31 +257,192 @@ double CurrencyConverter::convert(const std::string& fromCode, const std::string
 }
 
 std::string CurrencyConverter::getReport(const std::string& code, double amount, const std::string& country) const {
+    if (!recorder) return reportUntraced(code, amount, country);
+    uint64_t start = recorder->now();
+    uint32_t seed = recorder->nextSeed();
+    MagicCurrency::seed(seed);
+    try {
+        std::string report = reportUntraced(code, amount, country);
+        recorder->recordReport(code, amount, country, seed, true, report, start, recorder->now() - start);
+        return report;
+    } catch (const std::exception&) {
+        recorder->recordReport(code, amount, country, seed, false, "", start, recorder->now() - start);
+        throw;
+    }
+}
+
+std::string CurrencyConverter::reportUntraced(const std::string& code, double amount, const std::string& country) const {
     auto it = currencies.find(normalizeCode(code));
     if (it == currencies.end()) throw std::runtime_error("Currency '" + code + "' not found.");
     return it->second->makeReport(amount, normalizeCountry(country));
 }
 
 void CurrencyConverter::fluctuateAll() {
-    for (auto& pair : currencies) {
-        pair.second->fluctuate();
+    uint64_t start = 0;
+    uint32_t seed = 0;
+    if (recorder) {
+        start = recorder->now();
+        seed = recorder->nextSeed();
+        MagicCurrency::seed(seed);
+    }
+    for (auto& entry : orderedIndex) {
+        entry.second->fluctuate();
+        notifyRateChanged(entry.second);
+    }
+    if (recorder) {
+        uint64_t latency = recorder->now() - start;
+        recorder->recordFluctuateAll(seed, traceRatesChecksum(*this), start, latency);
+    }
+}
+
+size_t CurrencyConverter::applyRateUpdates(const std::vector<RateUpdate>& updates) {
+    uint64_t start = recorder ? recorder->now() : 0;
+    size_t applied = 0;
+    for (const RateUpdate& update : updates) {
+        auto it = currencies.find(update.code);
+        if (it == currencies.end()) it = currencies.find(normalizeCode(update.code));
+        if (it == currencies.end() || !(update.rate > 0)) continue;
+        it->second->setRate(update.rate);
+        notifyRateChanged(it->second.get());
+        applied++;
     }
+    if (recorder) recorder->recordRateUpdates(updates, applied, start, recorder->now() - start);
+    return applied;
+}
+
+void CurrencyConverter::trackDependency(const Currency* currency, Portfolio* portfolio) {
+    dependents[currency].push_back(portfolio);
+}
+
+void CurrencyConverter::dropDependency(const Currency* currency, Portfolio* portfolio) {
+    auto it = dependents.find(currency);
+    if (it == dependents.end()) return;
+    auto& portfolios = it->second;
+    portfolios.erase(std::remove(portfolios.begin(), portfolios.end(), portfolio), portfolios.end());
+    if (portfolios.empty()) dependents.erase(it);
+}
+
+// A reloaded currency replaces the object portfolios were priced against, so they are
+// moved over to the new one and re-priced.
+void CurrencyConverter::rebindDependents(const Currency* previous, const std::shared_ptr<Currency>& replacement) {
+    auto it = dependents.find(previous);
+    if (it == dependents.end()) return;
+    std::vector<Portfolio*> portfolios = std::move(it->second);
+    dependents.erase(it);
+    auto& moved = dependents[replacement.get()];
+    for (Portfolio* portfolio : portfolios) {
+        portfolio->rebindCurrency(previous, replacement);
+        moved.push_back(portfolio);
+    }
+}
+
+void CurrencyConverter::notifyRateChanged(const Currency* currency) {
+    if (dependents.empty()) return;
+    auto it = dependents.find(currency);
+    if (it == dependents.end()) return;
+    for (Portfolio* portfolio : it->second) {
+        portfolio->onRateChanged(currency);
+    }
+}
+
+size_t CurrencyConverter::listCurrencies(const Currency** out, size_t capacity, const std::string& typeFilter,
+                                         const std::string& afterCode) const {
+    std::string type = normalizeCode(typeFilter);
+    std::string after = normalizeCode(afterCode);
+    auto it = orderedIndex.begin();
+    if (!after.empty()) {
+        // The cursor is a code, not a pointer, so it stays valid when that currency is replaced.
+        // Without a type filter it resumes after the code's current type.
+        std::string afterType = type;
+        if (afterType.empty()) {
+            auto current = codeIndex.find(after);
+            if (current == codeIndex.end()) throw std::runtime_error("Currency '" + afterCode + "' not found.");
+            afterType = normalizeCode(current->second->getType());
+        }
+        it = orderedIndex.upper_bound({afterType, after});
+    }
+    if (!type.empty() && it != orderedIndex.end() && it->first.first < type)
+        it = orderedIndex.lower_bound({type, ""});
+
+    size_t count = 0;
+    for (; it != orderedIndex.end() && count < capacity; ++it) {
+        if (!type.empty() && it->first.first != type) break;
+        out[count++] = it->second;
+    }
+    return count;
+}
+
+// Optimal string alignment distance of at most one: a single insertion, deletion,
+// substitution or swap of adjacent characters.
+static bool withinOneEdit(std::string_view a, std::string_view b) {
+    if (a.size() < b.size()) return withinOneEdit(b, a);
+    if (a.size() - b.size() > 1) return false;
+    size_t i = 0;
+    while (i < b.size() && a[i] == b[i]) i++;
+    if (i == b.size()) return true;
+    if (a.size() > b.size()) return a.substr(i + 1) == b.substr(i);
+    if (a.substr(i + 1) == b.substr(i + 1)) return true;
+    return i + 1 < a.size() && a[i] == b[i + 1] && a[i + 1] == b[i] && a.substr(i + 2) == b.substr(i + 2);
+}
+
+// Prefix matches cost O(log n + k). Typo matches look up the query and its q deletions
+// in typoIndex and verify every code in those buckets, so they cost O(q * m log m) on
+// top, where m is the number of codes sharing a bucket with the query.
+size_t CurrencyConverter::findCurrencies(const std::string& prefix, const Currency** out, size_t capacity,
+                                         bool tolerateTypo) const {
+    std::string query = normalizeCode(prefix);
+    size_t count = 0;
+    for (auto it = codeIndex.lower_bound(query);
+         it != codeIndex.end() && count < capacity && it->first.compare(0, query.size(), query) == 0; ++it) {
+        out[count++] = it->second;
+    }
+    if (!tolerateTypo || query.empty() || count == capacity) return count;
+
+    // A code matches when the query is within one edit of its prefix of length q - 1,
+    // q or q + 1; symmetric deletes also pair codes two edits apart, so confirm it.
+    auto matchesTypo = [&query](std::string_view code) {
+        if (code.compare(0, query.size(), query) == 0) return false;
+        for (size_t length = query.size() - 1; length <= query.size() + 1; length++) {
+            if (length > 0 && length <= code.size() && withinOneEdit(query, code.substr(0, length))) return true;
+        }
+        return false;
+    };
+    std::vector<const std::string*> candidates;
+    auto collect = [&](const std::string& key) {
+        auto found = typoIndex.find(key);
+        if (found == typoIndex.end()) return;
+        for (const std::string& code : found->second) {
+            if (matchesTypo(code)) candidates.push_back(&code);
+        }
+    };
+    collect(query);
+    std::string deletion;
+    for (size_t skip = 0; query.size() > 1 && skip < query.size(); skip++) {
+        deletion.assign(query, 0, skip).append(query, skip + 1, std::string::npos);
+        collect(deletion);
+    }
+
+    std::sort(candidates.begin(), candidates.end(),
+              [](const std::string* a, const std::string* b) { return *a < *b; });
+    for (size_t i = 0; i < candidates.size() && count < capacity; i++) {
+        if (i > 0 && *candidates[i] == *candidates[i - 1]) continue;
+        out[count++] = codeIndex.at(*candidates[i]);
+    }
+    return count;
+}
+
+void CurrencyConverter::setTraceRecorder(const std::shared_ptr<TraceRecorder>& _recorder) {
+    recorder = _recorder;
+}
+
+std::shared_ptr<TraceRecorder> CurrencyConverter::getTraceRecorder() const {
+    return recorder;
 }
 
 void CurrencyConverter::listAllCurrencies() const {
-    std::vector<std::shared_ptr<Currency>> currencyList;
-    for (const auto& pair : currencies) {
-        currencyList.push_back(pair.second);
-    }
-    std::sort(currencyList.begin(), currencyList.end(),
-             [](const std::shared_ptr<Currency>& a,
-                const std::shared_ptr<Currency>& b) {
-                if (a->getType() == b->getType())
-                    return a->getCode() < b->getCode();
-                return a->getType() < b->getType();
-             });
     std::cout << "Available currencies:\n";
-    for (const auto& currency : currencyList) {
+    for (const auto& entry : orderedIndex) {
+        const Currency* currency = entry.second;
         std::cout << "-" << currency->getCode() << " " << currency->getSymbol()
                   << " (" << currency->getType() << ")\n";
     }
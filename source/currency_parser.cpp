@@ -3,6 +3,15 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 #include "currency_parser.h"
 #include "currency.h"
 
@@ -34,6 +43,52 @@ std::vector<std::string> splitCountries(const std::string& countriesStr) {
     return countries;
 }
 
+std::shared_ptr<CryptoCurrency> parseCryptoLine(const std::string& line) {
+    auto fields = splitCSVLine(line);
+    if (fields.size() < 6) return nullptr;
+
+    std::string code = fields[0];
+    std::string symbol = fields[1];
+    double rate = std::stod(fields[2]);
+    double taxRate = std::stod(fields[3]);
+    double volatility = std::stod(fields[4]);
+    auto allowedCountries = splitCountries(fields[5]);
+
+    return std::make_shared<CryptoCurrency>(code, symbol,
+        rate, taxRate, volatility, allowedCountries);
+}
+
+std::shared_ptr<FiatCurrency> parseFiatLine(const std::string& line) {
+    auto fields = splitCSVLine(line);
+    if (fields.size() < 6) return nullptr;
+
+    std::string code = fields[0];
+    std::string symbol = fields[1];
+    double rate = std::stod(fields[2]);
+    double taxRate = std::stod(fields[3]);
+    double inflationRate = std::stod(fields[4]);
+    auto allowedCountries = splitCountries(fields[5]);
+
+    return std::make_shared<FiatCurrency>(code, symbol,
+        rate, taxRate, inflationRate, allowedCountries);
+}
+
+std::shared_ptr<MagicCurrency> parseMagicLine(const std::string& line) {
+    auto fields = splitCSVLine(line);
+    if (fields.size() < 7) return nullptr;
+
+    std::string code = fields[0];
+    std::string symbol = fields[1];
+    double rate = std::stod(fields[2]);
+    double taxRate = std::stod(fields[3]);
+    int rarityLevel = std::stoi(fields[4]);
+    std::string incantation = fields[5];
+    std::string realmOrigin = fields[6];
+
+    return std::make_shared<MagicCurrency>(code, symbol,
+        rate, taxRate, rarityLevel, incantation, realmOrigin);
+}
+
 std::vector<std::shared_ptr<CryptoCurrency>> loadCryptoCurrencies(const std::string& filename) {
     std::vector<std::shared_ptr<CryptoCurrency>> currencies;
     std::ifstream file(filename);
@@ -46,21 +101,9 @@ std::vector<std::shared_ptr<CryptoCurrency>> loadCryptoCurrencies(const std::str
     std::getline(file, line); //skip the header
 
     while (std::getline(file, line)) {
-        auto fields = splitCSVLine(line);
-        if (fields.size() < 6) continue;
-
         try {
-            std::string code = fields[0];
-            std::string symbol = fields[1];
-            double rate = std::stod(fields[2]);
-            double taxRate = std::stod(fields[3]);
-            double volatility = std::stod(fields[4]);
-            auto allowedCountries = splitCountries(fields[5]);
-
-            auto currency = std::make_shared<CryptoCurrency>(code, symbol,
-                rate, taxRate, volatility, allowedCountries);
-            currencies.push_back(currency);
-
+            auto currency = parseCryptoLine(line);
+            if (currency) currencies.push_back(currency);
         } catch(const std::exception& exception) {
             std::cerr << "Error parsing line: \"" << line << "\" - "
             << exception.what() << "\n";
@@ -81,21 +124,9 @@ std::vector<std::shared_ptr<FiatCurrency>> loadFiatCurrencies(const std::string&
     std::getline(file, line); //skip the header
 
     while (std::getline(file, line)) {
-        auto fields = splitCSVLine(line);
-        if (fields.size() < 6) continue;
-
         try {
-            std::string code = fields[0];
-            std::string symbol = fields[1];
-            double rate = std::stod(fields[2]);
-            double taxRate = std::stod(fields[3]);
-            double inflationRate = std::stod(fields[4]);
-            auto allowedCountries = splitCountries(fields[5]);
-
-            auto currency = std::make_shared<FiatCurrency>(code, symbol,
-                rate, taxRate, inflationRate, allowedCountries);
-            currencies.push_back(currency);
-
+            auto currency = parseFiatLine(line);
+            if (currency) currencies.push_back(currency);
         } catch(const std::exception& exception) {
             std::cerr << "Error parsing line: \"" << line << "\" - "
             << exception.what() << "\n";
@@ -116,26 +147,113 @@ std::vector<std::shared_ptr<MagicCurrency>> loadMagicCurrencies(const std::strin
     std::getline(file, line); //skip the header
 
     while (std::getline(file, line)) {
-        auto fields = splitCSVLine(line);
-        if (fields.size() < 7) continue;
-
         try {
-            std::string code = fields[0];
-            std::string symbol = fields[1];
-            double rate = std::stod(fields[2]);
-            double taxRate = std::stod(fields[3]);
-            int rarityLevel = std::stoi(fields[4]);
-            std::string incantation = fields[5];
-            std::string realmOrigin = fields[6];
-
-            auto currency = std::make_shared<MagicCurrency>(code, symbol,
-                rate, taxRate, rarityLevel, incantation, realmOrigin);
-            currencies.push_back(currency);
-
+            auto currency = parseMagicLine(line);
+            if (currency) currencies.push_back(currency);
         } catch(const std::exception& exception) {
             std::cerr << "Error parsing line: \"" << line << "\" - "
             << exception.what() << "\n";
         }
     }
     return currencies;
-}
\ No newline at end of file
+}
+
+static std::shared_ptr<Currency> parseLine(CurrencyKind kind, const std::string& line) {
+    switch (kind) {
+    case CurrencyKind::Crypto: return parseCryptoLine(line);
+    case CurrencyKind::Fiat: return parseFiatLine(line);
+    case CurrencyKind::Magic: return parseMagicLine(line);
+    }
+    return nullptr;
+}
+
+static constexpr size_t kMaxRecordLength = 64 * 1024;
+
+// Reads fixed-size chunks and keeps only the current (possibly partial) record,
+// so memory stays bounded by the chunk size and kMaxRecordLength.
+template <typename ReadChunk>
+static LoadProgress streamLines(CurrencyKind kind, CurrencyConverter& converter,
+                                const std::function<void(const LoadProgress&)>& onProgress,
+                                size_t chunkSize, ReadChunk readChunk) {
+    LoadProgress progress;
+    std::vector<char> chunk(chunkSize > 0 ? chunkSize : 1);
+    std::string line;
+    bool header = true;
+    bool skippingLine = false;
+
+    auto finishLine = [&]() {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (header) header = false; //skip the header
+        else if (!line.empty()) {
+            try {
+                auto currency = parseLine(kind, line);
+                if (currency) {
+                    converter.addCurrency(currency);
+                    progress.records++;
+                } else progress.errors++;
+            } catch(const std::exception& exception) {
+                std::cerr << "Error parsing line: \"" << line << "\" - "
+                << exception.what() << "\n";
+                progress.errors++;
+            }
+        }
+        line.clear();
+    };
+
+    while (true) {
+        long long n = readChunk(chunk.data(), chunk.size());
+        if (n <= 0) break;
+        progress.bytes += n;
+
+        const char* begin = chunk.data();
+        const char* end = begin + n;
+        while (begin < end) {
+            const char* newline = std::find(begin, end, '\n');
+            if (!skippingLine && line.size() + (newline - begin) > kMaxRecordLength) {
+                // An oversized record: drop it up to the next newline.
+                std::cerr << "Skipping a record longer than " << kMaxRecordLength << " bytes\n";
+                progress.errors++;
+                skippingLine = true;
+                line.clear();
+            }
+            if (!skippingLine) line.append(begin, newline);
+            if (newline == end) break;
+            if (skippingLine) {
+                skippingLine = false;
+                header = false;
+            } else finishLine();
+            begin = newline + 1;
+        }
+        if (onProgress) onProgress(progress);
+    }
+    if (!line.empty()) {
+        finishLine();
+        if (onProgress) onProgress(progress);
+    }
+    return progress;
+}
+
+LoadProgress streamCurrencies(CurrencyKind kind, std::istream& in, CurrencyConverter& converter,
+                              const std::function<void(const LoadProgress&)>& onProgress, size_t chunkSize) {
+    return streamLines(kind, converter, onProgress, chunkSize, [&in](char* buffer, size_t size) -> long long {
+        in.read(buffer, static_cast<std::streamsize>(size));
+        if (in.bad()) throw std::runtime_error("Couldn't read the catalog stream.");
+        return in.gcount();
+    });
+}
+
+LoadProgress streamCurrencies(CurrencyKind kind, int fd, CurrencyConverter& converter,
+                              const std::function<void(const LoadProgress&)>& onProgress, size_t chunkSize) {
+    return streamLines(kind, converter, onProgress, chunkSize, [fd](char* buffer, size_t size) -> long long {
+        while (true) {
+#ifdef _WIN32
+            long long n = _read(fd, buffer, static_cast<unsigned>(size));
+#else
+            long long n = read(fd, buffer, size);
+#endif
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0) throw std::runtime_error(std::string("Couldn't read the catalog: ") + std::strerror(errno));
+            return n;
+        }
+    });
+}
@@ -4,14 +4,19 @@
 #include "currency.h"
 #include "currency_parser.h"
 #include "text_formatting.h"
+#include "trace.h"
 #include <windows.h>
 #include <limits>
 #include <iomanip>
+#include <cstdlib>
 
 int main() {
     SetConsoleOutputCP(CP_UTF8);
 
     CurrencyConverter converter;
+    if (const char* tracePath = std::getenv("CURRENCY_TRACE")) {
+        converter.setTraceRecorder(std::make_shared<TraceRecorder>(tracePath));
+    }
 
     auto cryptoCurrencies = loadCryptoCurrencies("crypto_exchange_rates.csv");
     auto fiatCurrencies = loadFiatCurrencies("fiat_exchange_rates.csv");
@@ -0,0 +1,87 @@
+#include "portfolio.h"
+#include "text_formatting.h"
+
+Portfolio::Portfolio(CurrencyConverter& _converter, const std::string& baseCode)
+    : converter(_converter), base(_converter.getCurrency(baseCode)), totalInUSD(0) {
+    converter.trackDependency(base.get(), this);
+}
+
+Portfolio::~Portfolio() {
+    converter.dropDependency(base.get(), this);
+    for (const Position& position : positions) {
+        converter.dropDependency(position.currency.get(), this);
+    }
+}
+
+void Portfolio::addPosition(const std::string& code, double amount) {
+    std::shared_ptr<Currency> currency = converter.getCurrency(code);
+    auto it = positionOf.find(currency.get());
+    if (it == positionOf.end()) {
+        it = positionOf.emplace(currency.get(), positions.size()).first;
+        positions.push_back(Position{currency, 0, 0, 0});
+        if (currency != base) converter.trackDependency(currency.get(), this);
+    }
+
+    Position& position = positions[it->second];
+    position.amount += amount;
+    reprice(position);
+}
+
+void Portfolio::reprice(Position& position) {
+    position.netAmount = position.amount - position.currency->applyTaxOrFee(position.amount);
+    double value = position.netAmount * position.currency->getRate();
+    totalInUSD += value - position.valueInUSD;
+    position.valueInUSD = value;
+}
+
+// The replacement may charge a different fee, so the net amount is recomputed too.
+void Portfolio::rebindCurrency(const Currency* previous, const std::shared_ptr<Currency>& replacement) {
+    if (base.get() == previous) base = replacement;
+    auto it = positionOf.find(previous);
+    if (it == positionOf.end()) return;
+    size_t index = it->second;
+    positionOf.erase(it);
+    positionOf[replacement.get()] = index;
+    positions[index].currency = replacement;
+    reprice(positions[index]);
+}
+
+// Liquidation cost depends only on the held amount, so a rate change just
+// re-prices the cached net amount and adjusts the total by the delta.
+void Portfolio::onRateChanged(const Currency* currency) {
+    auto it = positionOf.find(currency);
+    if (it == positionOf.end()) return;
+    Position& position = positions[it->second];
+    double value = position.netAmount * currency->getRate();
+    totalInUSD += value - position.valueInUSD;
+    position.valueInUSD = value;
+}
+
+double Portfolio::getPosition(const std::string& code) const {
+    auto currency = converter.getCurrency(code);
+    auto it = positionOf.find(currency.get());
+    return it == positionOf.end() ? 0 : positions[it->second].amount;
+}
+
+size_t Portfolio::getPositionCount() const {
+    return positions.size();
+}
+
+std::string Portfolio::getBaseCode() const {
+    return base->getCode();
+}
+
+double Portfolio::getTotalValue() const {
+    return totalInUSD / base->getRate();
+}
+
+// Recomputes every position from scratch, dropping any rounding drift the
+// incremental updates accumulated.
+double Portfolio::revalueAll() {
+    totalInUSD = 0;
+    for (Position& position : positions) {
+        position.valueInUSD = position.netAmount * position.currency->getRate();
+        totalInUSD += position.valueInUSD;
+    }
+    return getTotalValue();
+}
@@ -0,0 +1,188 @@
+#include "rate_feed.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+#include <unistd.h>
+
+RateFeed::RateFeed(int _fd, CurrencyConverter& _converter, size_t _maxBatchSize,
+                   std::chrono::microseconds _batchWindow, size_t bufferSize)
+    : fd(_fd), converter(_converter), maxBatchSize(std::max<size_t>(_maxBatchSize, 1)),
+      batchWindow(_batchWindow), buffer(std::max<size_t>(bufferSize, 64)), buffered(0),
+      skippingLine(false), started(std::chrono::steady_clock::now()), batchStarted(started) {}
+
+size_t RateFeed::poll() {
+    uint64_t before = stats.records;
+    while (true) {
+        ssize_t n = read(fd, buffer.data() + buffered, buffer.size() - buffered);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            throw std::runtime_error(std::string("Couldn't read rate feed: ") + std::strerror(errno));
+        }
+        if (n > 0) {
+            stats.bytesRead += n;
+            buffered += n;
+            consume();
+        }
+        break;
+    }
+    flushIfDue();
+    return stats.records - before;
+}
+
+size_t RateFeed::ingest(const char* data, size_t size) {
+    uint64_t before = stats.records;
+    while (size > 0) {
+        size_t n = std::min(size, buffer.size() - buffered);
+        std::memcpy(buffer.data() + buffered, data, n);
+        stats.bytesRead += n;
+        buffered += n;
+        data += n;
+        size -= n;
+        consume();
+    }
+    flushIfDue();
+    return stats.records - before;
+}
+
+void RateFeed::consume() {
+    const char* begin = buffer.data();
+    const char* end = begin + buffered;
+    const char* lineStart = begin;
+    while (const char* newline = static_cast<const char*>(std::memchr(lineStart, '\n', end - lineStart))) {
+        if (skippingLine) skippingLine = false;
+        else parseLine(lineStart, newline);
+        lineStart = newline + 1;
+    }
+
+    size_t remaining = end - lineStart;
+    if (remaining == buffer.size()) {
+        // A record longer than the whole buffer: drop it up to the next newline.
+        if (!skippingLine) stats.malformed++;
+        skippingLine = true;
+        buffered = 0;
+        return;
+    }
+    if (lineStart != begin) std::memmove(buffer.data(), lineStart, remaining);
+    buffered = remaining;
+}
+
+static const char* trimLeft(const char* begin, const char* end) {
+    while (begin < end && (*begin == ' ' || *begin == '\t')) begin++;
+    return begin;
+}
+
+static const char* trimRight(const char* begin, const char* end) {
+    while (end > begin && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) end--;
+    return end;
+}
+
+void RateFeed::parseLine(const char* begin, const char* end) {
+    begin = trimLeft(begin, end);
+    end = trimRight(begin, end);
+    if (begin == end || *begin == '#') return;
+
+    const char* firstComma = static_cast<const char*>(std::memchr(begin, ',', end - begin));
+    const char* secondComma = firstComma ?
+        static_cast<const char*>(std::memchr(firstComma + 1, ',', end - firstComma - 1)) : nullptr;
+    if (!secondComma) {
+        stats.malformed++;
+        return;
+    }
+
+    const char* codeEnd = trimRight(begin, firstComma);
+    const char* rateBegin = trimLeft(firstComma + 1, secondComma);
+    const char* rateEnd = trimRight(rateBegin, secondComma);
+    const char* timeBegin = trimLeft(secondComma + 1, end);
+
+    double rate = 0;
+    int64_t timestamp = 0;
+    auto rateResult = std::from_chars(rateBegin, rateEnd, rate);
+    auto timeResult = std::from_chars(timeBegin, end, timestamp);
+    if (begin == codeEnd || rateResult.ec != std::errc() || rateResult.ptr != rateEnd ||
+        timeResult.ec != std::errc() || timeResult.ptr != end || !(rate > 0)) {
+        stats.malformed++;
+        return;
+    }
+
+    code.assign(begin, codeEnd);
+    std::transform(code.begin(), code.end(), code.begin(),
+                   [](unsigned char c) { return std::toupper(c); });
+    stats.records++;
+
+    auto it = slotOf.find(code);
+    size_t slot;
+    if (it == slotOf.end()) {
+        // Only catalog codes get a slot, so a noisy feed can't grow the table.
+        if (converter.getAllCurrencies().count(code) == 0) {
+            stats.unknown++;
+            return;
+        }
+        slot = slots.size();
+        slotOf.emplace(code, slot);
+        slots.push_back(RateUpdate{code, rate, timestamp});
+        pending.push_back(0);
+    } else slot = it->second;
+
+    if (!pending[slot]) {
+        // Older than what an earlier batch already applied: an out-of-order tick.
+        if (timestamp < slots[slot].timestamp) {
+            stats.stale++;
+            return;
+        }
+        if (touched.empty()) batchStarted = std::chrono::steady_clock::now();
+        pending[slot] = 1;
+        touched.push_back(slot);
+        slots[slot].rate = rate;
+        slots[slot].timestamp = timestamp;
+    } else {
+        stats.coalesced++;
+        if (timestamp >= slots[slot].timestamp) {
+            slots[slot].rate = rate;
+            slots[slot].timestamp = timestamp;
+        }
+    }
+
+    if (touched.size() >= maxBatchSize) flush();
+}
+
+void RateFeed::flushIfDue() {
+    if (touched.empty()) return;
+    if (std::chrono::steady_clock::now() - batchStarted >= batchWindow) flush();
+}
+
+size_t RateFeed::flush() {
+    if (touched.empty()) return 0;
+
+    batch.clear();
+    for (size_t slot : touched) {
+        batch.push_back(slots[slot]);
+        pending[slot] = 0;
+    }
+    touched.clear();
+
+    size_t applied = converter.applyRateUpdates(batch);
+    auto now = std::chrono::steady_clock::now();
+    auto lag = std::chrono::duration_cast<std::chrono::microseconds>(now - batchStarted);
+
+    stats.batches++;
+    stats.applied += applied;
+    stats.unknown += batch.size() - applied;
+    stats.lastApplyLag = lag;
+    stats.maxApplyLag = std::max(stats.maxApplyLag, lag);
+    return applied;
+}
+
+size_t RateFeed::getPendingCount() const {
+    return touched.size();
+}
+
+RateFeedStats RateFeed::getStats() const {
+    RateFeedStats result = stats;
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+    result.recordsPerSecond = elapsed.count() > 0 ? stats.records / elapsed.count() : 0;
+    return result;
+}
@@ -0,0 +1,322 @@
+#include "shared_rates.h"
+#include "text_formatting.h"
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <cstring>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+constexpr uint32_t kSharedRatesMagic = 0x52415445; // "RATE"
+constexpr size_t kMaxCodeLength = 16;
+constexpr uint32_t kMaxReadAttempts = 1u << 20;
+}
+
+// --- Segment layout ---
+struct SharedRateHeader {
+    std::atomic<uint32_t> magic;
+    uint32_t capacity;
+    std::atomic<uint64_t> generation;
+    std::atomic<uint32_t> count;
+    std::atomic<uint32_t> retired;
+};
+
+struct SharedRateSlot {
+    std::atomic<uint32_t> sequence;
+    std::atomic<uint64_t> code[kMaxCodeLength / sizeof(uint64_t)];
+    std::atomic<double> rate;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared rates need lock-free 64-bit atomics");
+static_assert(std::atomic<double>::is_always_lock_free, "shared rates need lock-free double atomics");
+
+static size_t segmentSize(uint32_t capacity) {
+    return sizeof(SharedRateHeader) + capacity * sizeof(SharedRateSlot);
+}
+
+static SharedRateSlot* slotsOf(const SharedRateHeader* header) {
+    return reinterpret_cast<SharedRateSlot*>(
+        reinterpret_cast<char*>(const_cast<SharedRateHeader*>(header)) + sizeof(SharedRateHeader));
+}
+
+static std::string shmName(const std::string& name) {
+    return name.empty() || name[0] != '/' ? "/" + name : name;
+}
+
+static void writeSlot(SharedRateSlot& slot, const std::string* code, double rate) {
+    uint32_t seq = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    if (code) {
+        uint64_t words[kMaxCodeLength / sizeof(uint64_t)] = {};
+        std::memcpy(words, code->data(), code->size());
+        for (size_t i = 0; i < kMaxCodeLength / sizeof(uint64_t); i++)
+            slot.code[i].store(words[i], std::memory_order_relaxed);
+    }
+    slot.rate.store(rate, std::memory_order_relaxed);
+    slot.sequence.store(seq + 2, std::memory_order_release);
+}
+
+// Seqlock read: retry until the slot was not being written while we copied it. Gives up
+// when the segment gets retired or the writer seems to have died mid-update.
+static bool readSlot(const SharedRateHeader& header, const SharedRateSlot& slot, double& rate, std::string* code) {
+    for (uint32_t attempt = 0; attempt < kMaxReadAttempts; attempt++) {
+        uint32_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before & 1) {
+            if (header.retired.load(std::memory_order_acquire)) return false;
+            continue;
+        }
+        uint64_t words[kMaxCodeLength / sizeof(uint64_t)];
+        if (code) {
+            for (size_t i = 0; i < kMaxCodeLength / sizeof(uint64_t); i++)
+                words[i] = slot.code[i].load(std::memory_order_relaxed);
+        }
+        double value = slot.rate.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != before) continue;
+        if (code) {
+            const char* chars = reinterpret_cast<const char*>(words);
+            code->assign(chars, strnlen(chars, kMaxCodeLength));
+        }
+        rate = value;
+        return true;
+    }
+    return false;
+}
+
+// --- SharedRatePublisher ---
+SharedRatePublisher::SharedRatePublisher(const std::string& _name, uint32_t _capacity)
+    : name(shmName(_name)), capacity(_capacity), mapping(nullptr), mappingSize(segmentSize(_capacity)),
+      header(nullptr), slots(nullptr) {
+    if (capacity == 0) throw std::runtime_error("Shared rate table capacity must be positive.");
+
+    // Generations keep increasing across recreated segments so IDs cached by readers
+    // never validate against a new layout.
+    uint64_t firstGeneration = (static_cast<uint64_t>(std::random_device{}()) << 32) ^
+        static_cast<uint64_t>(std::chrono::system_clock::now().time_since_epoch().count());
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd >= 0) {
+        struct stat info {};
+        void* existing = MAP_FAILED;
+        if (fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= sizeof(SharedRateHeader))
+            existing = mmap(nullptr, info.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+        if (existing != MAP_FAILED) {
+            auto* old = static_cast<SharedRateHeader*>(existing);
+            bool reusable = old->magic.load(std::memory_order_acquire) == kSharedRatesMagic &&
+                            old->capacity == capacity &&
+                            static_cast<size_t>(info.st_size) == mappingSize &&
+                            old->retired.load(std::memory_order_acquire) == 0;
+            if (reusable) {
+                // A previous publisher left the segment behind: take it over and bump the
+                // generation so attached readers drop their interned IDs.
+                mapping = existing;
+                header = old;
+                slots = slotsOf(header);
+                for (uint32_t i = 0; i < capacity; i++) {
+                    uint32_t seq = slots[i].sequence.load(std::memory_order_relaxed);
+                    if (seq & 1) slots[i].sequence.store(seq + 1, std::memory_order_release);
+                }
+                header->count.store(0, std::memory_order_release);
+                header->generation.fetch_add(1, std::memory_order_acq_rel);
+                close(fd);
+                return;
+            }
+            if (old->magic.load(std::memory_order_acquire) == kSharedRatesMagic)
+                firstGeneration = old->generation.load(std::memory_order_acquire) + 1;
+            old->retired.store(1, std::memory_order_release);
+            munmap(existing, info.st_size);
+        }
+        close(fd);
+        shm_unlink(name.c_str());
+    }
+
+    fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0) throw std::runtime_error("Couldn't create shared rate table " + name);
+    if (ftruncate(fd, static_cast<off_t>(mappingSize)) != 0) {
+        close(fd);
+        shm_unlink(name.c_str());
+        throw std::runtime_error("Couldn't size shared rate table " + name);
+    }
+    mapping = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        mapping = nullptr;
+        shm_unlink(name.c_str());
+        throw std::runtime_error("Couldn't map shared rate table " + name);
+    }
+
+    header = static_cast<SharedRateHeader*>(mapping);
+    slots = slotsOf(header);
+    header->capacity = capacity;
+    header->generation.store(firstGeneration, std::memory_order_relaxed);
+    header->count.store(0, std::memory_order_relaxed);
+    header->retired.store(0, std::memory_order_relaxed);
+    header->magic.store(kSharedRatesMagic, std::memory_order_release);
+}
+
+SharedRatePublisher::~SharedRatePublisher() {
+    if (mapping) munmap(mapping, mappingSize);
+}
+
+uint32_t SharedRatePublisher::publish(const std::string& code, double rate) {
+    std::string key = normalizeCode(code);
+    auto it = ids.find(key);
+    if (it != ids.end()) {
+        writeSlot(slots[it->second], nullptr, rate);
+        return it->second;
+    }
+
+    if (key.empty() || key.size() > kMaxCodeLength)
+        throw std::runtime_error("Currency code '" + code + "' can't be shared.");
+    uint32_t id = header->count.load(std::memory_order_relaxed);
+    if (id >= capacity) throw std::runtime_error("Shared rate table " + name + " is full.");
+
+    writeSlot(slots[id], &key, rate);
+    header->count.store(id + 1, std::memory_order_release);
+    ids.emplace(key, id);
+    return id;
+}
+
+void SharedRatePublisher::publishAll(const CurrencyConverter& converter) {
+    for (const auto& pair : converter.getAllCurrencies()) {
+        publish(pair.first, pair.second->getRate());
+    }
+}
+
+uint64_t SharedRatePublisher::getGeneration() const {
+    return header->generation.load(std::memory_order_acquire);
+}
+
+uint32_t SharedRatePublisher::getCapacity() const { return capacity; }
+
+void SharedRatePublisher::remove(const std::string& name) {
+    shm_unlink(shmName(name).c_str());
+}
+
+// --- SharedRateView ---
+SharedRateView::SharedRateView(const std::string& _name)
+    : name(shmName(_name)), mapping(nullptr), mappingSize(0), header(nullptr), slots(nullptr),
+      generation(0), indexedCount(0) {
+    attach();
+}
+
+SharedRateView::~SharedRateView() {
+    detach();
+}
+
+void SharedRateView::attach() const {
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) throw std::runtime_error("Shared rate table " + name + " not found.");
+
+    struct stat info {};
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(SharedRateHeader)) {
+        close(fd);
+        throw std::runtime_error("Shared rate table " + name + " is not ready.");
+    }
+    void* candidate = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (candidate == MAP_FAILED) throw std::runtime_error("Couldn't map shared rate table " + name);
+
+    auto* candidateHeader = static_cast<const SharedRateHeader*>(candidate);
+    if (candidateHeader->magic.load(std::memory_order_acquire) != kSharedRatesMagic ||
+        static_cast<size_t>(info.st_size) < segmentSize(candidateHeader->capacity)) {
+        munmap(candidate, info.st_size);
+        throw std::runtime_error("Shared rate table " + name + " is not ready.");
+    }
+
+    detach();
+    mapping = candidate;
+    mappingSize = info.st_size;
+    header = candidateHeader;
+    slots = slotsOf(header);
+    generation = header->generation.load(std::memory_order_acquire);
+    indexedCount = 0;
+    ids.clear();
+}
+
+void SharedRateView::detach() const {
+    if (mapping) munmap(mapping, mappingSize);
+    mapping = nullptr;
+    header = nullptr;
+    slots = nullptr;
+}
+
+// Hot path: two atomic loads when nothing changed. Remapping (the only syscalls)
+// happens when the publisher retired the segment and a new one exists.
+void SharedRateView::refresh() const {
+    if (header->retired.load(std::memory_order_acquire)) {
+        try {
+            attach();
+        } catch (const std::runtime_error&) {
+            // The new segment isn't there yet; keep serving the last published rates.
+        }
+    }
+
+    uint64_t current = header->generation.load(std::memory_order_acquire);
+    if (current != generation) {
+        generation = current;
+        indexedCount = 0;
+        ids.clear();
+    }
+
+    uint32_t count = header->count.load(std::memory_order_acquire);
+    if (count > header->capacity) count = header->capacity;
+    std::string code;
+    double rate;
+    for (; indexedCount < count; indexedCount++) {
+        if (!readSlot(*header, slots[indexedCount], rate, &code)) break;
+        ids[code] = indexedCount;
+    }
+}
+
+uint32_t SharedRateView::getId(const std::string& code) const {
+    refresh();
+    auto it = ids.find(normalizeCode(code));
+    if (it == ids.end()) throw std::runtime_error("Currency '" + code + "' not found.");
+    return it->second;
+}
+
+// IDs are only valid for the generation they were interned in: a restarted publisher
+// hands the same slots out to different codes.
+double SharedRateView::getRateById(uint32_t id, uint64_t expectedGeneration) const {
+    refresh();
+    if (generation != expectedGeneration || id >= indexedCount)
+        throw std::runtime_error("Shared rate ID " + std::to_string(id) + " is stale.");
+    double rate;
+    if (!readSlot(*header, slots[id], rate, nullptr))
+        throw std::runtime_error("Shared rate ID " + std::to_string(id) + " is unavailable.");
+    if (header->generation.load(std::memory_order_acquire) != expectedGeneration)
+        throw std::runtime_error("Shared rate ID " + std::to_string(id) + " is stale.");
+    return rate;
+}
+
+double SharedRateView::getRate(const std::string& code) const {
+    for (int attempt = 0; attempt < 3; attempt++) {
+        uint32_t id = getId(code);
+        double rate;
+        if (readSlot(*header, slots[id], rate, nullptr) &&
+            header->generation.load(std::memory_order_acquire) == generation) return rate;
+    }
+    throw std::runtime_error("Shared rate for '" + code + "' is unavailable.");
+}
+
+double SharedRateView::convert(const std::string& fromCode, const std::string& toCode, double amount) const {
+    double amountInUSD = amount * getRate(fromCode);
+    double converted = amountInUSD / getRate(toCode);
+    return converted;
+}
+
+size_t SharedRateView::size() const {
+    refresh();
+    return ids.size();
+}
+
+uint64_t SharedRateView::getGeneration() const {
+    refresh();
+    return generation;
+}
@@ -0,0 +1,331 @@
+#include "trace.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+constexpr char kTraceMagic[4] = {'C', 'T', 'R', 'C'};
+constexpr uint32_t kTraceVersion = 1;
+
+class TraceReader {
+private:
+    std::ifstream in;
+public:
+    explicit TraceReader(const std::string& filename) : in(filename, std::ios::binary) {
+        if (!in.is_open()) throw std::runtime_error("Couldn't open the trace " + filename);
+    }
+    template <typename T> T read() {
+        T value;
+        if (!in.read(reinterpret_cast<char*>(&value), sizeof(value)))
+            throw std::runtime_error("Trace is truncated.");
+        return value;
+    }
+    std::string readString() {
+        auto length = read<uint16_t>();
+        std::string value(length, '\0');
+        if (length > 0 && !in.read(&value[0], length)) throw std::runtime_error("Trace is truncated.");
+        return value;
+    }
+    std::vector<std::string> readStrings() {
+        auto count = read<uint32_t>();
+        std::vector<std::string> values;
+        for (uint32_t i = 0; i < count; i++) values.push_back(readString());
+        return values;
+    }
+    bool atEnd() {
+        return in.peek() == std::ifstream::traits_type::eof();
+    }
+};
+
+// A recorder on the replayed converter would reseed the RNG with its own seeds.
+class RecorderPause {
+private:
+    CurrencyConverter& converter;
+    std::shared_ptr<TraceRecorder> recorder;
+public:
+    explicit RecorderPause(CurrencyConverter& _converter)
+        : converter(_converter), recorder(_converter.getTraceRecorder()) {
+        converter.setTraceRecorder(nullptr);
+    }
+    ~RecorderPause() { converter.setTraceRecorder(recorder); }
+};
+
+bool sameBits(double a, double b) {
+    return std::memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+std::shared_ptr<Currency> readCurrency(TraceReader& reader) {
+    std::string type = reader.readString();
+    std::string code = reader.readString();
+    std::string symbol = reader.readString();
+    auto rate = reader.read<double>();
+    auto taxRate = reader.read<double>();
+    if (type == "Crypto") {
+        auto volatility = reader.read<double>();
+        return std::make_shared<CryptoCurrency>(code, symbol, rate, taxRate, volatility, reader.readStrings());
+    }
+    if (type == "Fiat") {
+        auto inflationRate = reader.read<double>();
+        return std::make_shared<FiatCurrency>(code, symbol, rate, taxRate, inflationRate, reader.readStrings());
+    }
+    if (type == "Magic") {
+        auto rarityLevel = reader.read<int32_t>();
+        std::string incantation = reader.readString();
+        std::string realmOrigin = reader.readString();
+        return std::make_shared<MagicCurrency>(code, symbol, rate, taxRate, rarityLevel, incantation, realmOrigin);
+    }
+    throw std::runtime_error("Trace has unknown currency type '" + type + "'.");
+}
+}
+
+uint64_t traceChecksum(const std::string& value) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : value) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// Order-independent, so it doesn't depend on how the converter stores currencies.
+uint64_t traceRatesChecksum(const CurrencyConverter& converter) {
+    uint64_t sum = 0;
+    for (const auto& pair : converter.getAllCurrencies()) {
+        double rate = pair.second->getRate();
+        std::string entry = pair.first;
+        entry.append(reinterpret_cast<const char*>(&rate), sizeof(rate));
+        sum += traceChecksum(entry);
+    }
+    return sum;
+}
+
+// --- TraceRecorder ---
+template <typename T> void TraceRecorder::writeValue(const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+TraceRecorder::TraceRecorder(const std::string& filename)
+    : out(filename, std::ios::binary | std::ios::trunc), seeds(std::random_device{}()),
+      started(std::chrono::steady_clock::now()), recordCount(0) {
+    if (!out.is_open()) throw std::runtime_error("Couldn't open the trace " + filename);
+    out.write(kTraceMagic, sizeof(kTraceMagic));
+    writeValue(kTraceVersion);
+    writeValue<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+void TraceRecorder::writeString(const std::string& value) {
+    auto length = static_cast<uint16_t>(std::min<size_t>(value.size(), UINT16_MAX));
+    writeValue(length);
+    out.write(value.data(), length);
+}
+
+void TraceRecorder::writeRecordHeader(TraceOp op, uint64_t start, uint64_t latency) {
+    writeValue(op);
+    writeValue(start);
+    writeValue(latency);
+    recordCount++;
+}
+
+uint64_t TraceRecorder::now() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - started).count();
+}
+
+uint32_t TraceRecorder::nextSeed() {
+    return seeds();
+}
+
+void TraceRecorder::recordAddCurrency(const Currency& currency, uint64_t start, uint64_t latency) {
+    writeRecordHeader(TraceOp::AddCurrency, start, latency);
+    writeString(currency.getType());
+    writeString(currency.getCode());
+    writeString(currency.getSymbol());
+    writeValue(currency.getRate());
+    writeValue(currency.getTaxRate());
+
+    const std::vector<std::string>* countries = nullptr;
+    if (auto crypto = dynamic_cast<const CryptoCurrency*>(&currency)) {
+        writeValue(crypto->getVolatility());
+        countries = &crypto->getAllowedCountries();
+    } else if (auto fiat = dynamic_cast<const FiatCurrency*>(&currency)) {
+        writeValue(fiat->getInflationRate());
+        countries = &fiat->getAllowedCountries();
+    } else if (auto magic = dynamic_cast<const MagicCurrency*>(&currency)) {
+        writeValue<int32_t>(magic->getRarityLevel());
+        writeString(magic->getIncantation());
+        writeString(magic->getRealmOrigin());
+    }
+    if (countries) {
+        writeValue(static_cast<uint32_t>(countries->size()));
+        for (const std::string& country : *countries) writeString(country);
+    }
+}
+
+void TraceRecorder::recordConvert(const std::string& fromCode, const std::string& toCode, double amount,
+                                  bool ok, double result, uint64_t start, uint64_t latency) {
+    writeRecordHeader(TraceOp::Convert, start, latency);
+    writeString(fromCode);
+    writeString(toCode);
+    writeValue(amount);
+    writeValue<uint8_t>(ok);
+    writeValue(result);
+}
+
+void TraceRecorder::recordReport(const std::string& code, double amount, const std::string& country, uint32_t seed,
+                                 bool ok, const std::string& report, uint64_t start, uint64_t latency) {
+    writeRecordHeader(TraceOp::Report, start, latency);
+    writeString(code);
+    writeValue(amount);
+    writeString(country);
+    writeValue(seed);
+    writeValue<uint8_t>(ok);
+    writeValue(traceChecksum(report));
+}
+
+void TraceRecorder::recordFluctuateAll(uint32_t seed, uint64_t ratesChecksum, uint64_t start, uint64_t latency) {
+    writeRecordHeader(TraceOp::FluctuateAll, start, latency);
+    writeValue(seed);
+    writeValue(ratesChecksum);
+}
+
+void TraceRecorder::recordRateUpdates(const std::vector<RateUpdate>& updates, size_t applied,
+                                      uint64_t start, uint64_t latency) {
+    writeRecordHeader(TraceOp::RateUpdates, start, latency);
+    writeValue(static_cast<uint32_t>(updates.size()));
+    for (const RateUpdate& update : updates) {
+        writeString(update.code);
+        writeValue(update.rate);
+        writeValue(update.timestamp);
+    }
+    writeValue(static_cast<uint32_t>(applied));
+}
+
+void TraceRecorder::flush() {
+    out.flush();
+}
+
+uint64_t TraceRecorder::getRecordCount() const { return recordCount; }
+
+// --- Replay ---
+ReplayReport replayTrace(const std::string& filename, CurrencyConverter& converter, ReplaySpeed speed) {
+    TraceReader reader(filename);
+    char magic[sizeof(kTraceMagic)];
+    for (char& c : magic) c = reader.read<char>();
+    if (std::memcmp(magic, kTraceMagic, sizeof(magic)) != 0 || reader.read<uint32_t>() != kTraceVersion)
+        throw std::runtime_error("File " + filename + " is not a currency trace.");
+    reader.read<int64_t>(); // wall-clock start of the recording
+
+    RecorderPause pause(converter);
+
+    ReplayReport report;
+    std::vector<int64_t> latencies;
+    auto replayStarted = std::chrono::steady_clock::now();
+
+    while (!reader.atEnd()) {
+        auto op = reader.read<TraceOp>();
+        auto start = reader.read<uint64_t>();
+        reader.read<uint64_t>(); // recorded latency
+
+        std::shared_ptr<Currency> currency;
+        std::string fromCode, toCode, country;
+        double amount = 0, expectedResult = 0;
+        uint32_t seed = 0;
+        uint8_t expectedOk = 0;
+        uint64_t expectedChecksum = 0;
+        std::vector<RateUpdate> updates;
+        uint32_t expectedApplied = 0;
+        switch (op) {
+        case TraceOp::AddCurrency:
+            currency = readCurrency(reader);
+            break;
+        case TraceOp::Convert:
+            fromCode = reader.readString();
+            toCode = reader.readString();
+            amount = reader.read<double>();
+            expectedOk = reader.read<uint8_t>();
+            expectedResult = reader.read<double>();
+            break;
+        case TraceOp::Report:
+            fromCode = reader.readString();
+            amount = reader.read<double>();
+            country = reader.readString();
+            seed = reader.read<uint32_t>();
+            expectedOk = reader.read<uint8_t>();
+            expectedChecksum = reader.read<uint64_t>();
+            break;
+        case TraceOp::FluctuateAll:
+            seed = reader.read<uint32_t>();
+            expectedChecksum = reader.read<uint64_t>();
+            break;
+        case TraceOp::RateUpdates:
+            updates.resize(reader.read<uint32_t>());
+            for (RateUpdate& update : updates) {
+                update.code = reader.readString();
+                update.rate = reader.read<double>();
+                update.timestamp = reader.read<int64_t>();
+            }
+            expectedApplied = reader.read<uint32_t>();
+            break;
+        default:
+            throw std::runtime_error("Trace " + filename + " has an unknown record.");
+        }
+
+        if (speed == ReplaySpeed::Original)
+            std::this_thread::sleep_until(replayStarted + std::chrono::nanoseconds(start));
+
+        bool matches = true;
+        auto opStarted = std::chrono::steady_clock::now();
+        switch (op) {
+        case TraceOp::AddCurrency:
+            converter.addCurrency(currency);
+            break;
+        case TraceOp::Convert:
+            try {
+                double result = converter.convert(fromCode, toCode, amount);
+                matches = expectedOk && sameBits(result, expectedResult);
+            } catch (const std::exception&) {
+                matches = !expectedOk;
+            }
+            break;
+        case TraceOp::Report:
+            MagicCurrency::seed(seed);
+            try {
+                std::string result = converter.getReport(fromCode, amount, country);
+                matches = expectedOk && traceChecksum(result) == expectedChecksum;
+            } catch (const std::exception&) {
+                matches = !expectedOk;
+            }
+            break;
+        case TraceOp::FluctuateAll:
+            MagicCurrency::seed(seed);
+            converter.fluctuateAll();
+            break;
+        case TraceOp::RateUpdates:
+            matches = converter.applyRateUpdates(updates) == expectedApplied;
+            break;
+        }
+        auto opFinished = std::chrono::steady_clock::now();
+        if (op == TraceOp::FluctuateAll) matches = traceRatesChecksum(converter) == expectedChecksum;
+
+        latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(opFinished - opStarted).count());
+        report.operations++;
+        if (!matches) report.mismatches++;
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - replayStarted;
+    report.seconds = elapsed.count();
+    report.operationsPerSecond = report.seconds > 0 ? report.operations / report.seconds : 0;
+    if (!latencies.empty()) {
+        std::sort(latencies.begin(), latencies.end());
+        auto percentile = [&latencies](double p) {
+            size_t index = static_cast<size_t>(p * (latencies.size() - 1));
+            return std::chrono::nanoseconds(latencies[index]);
+        };
+        report.p50 = percentile(0.50);
+        report.p90 = percentile(0.90);
+        report.p99 = percentile(0.99);
+        report.max = std::chrono::nanoseconds(latencies.back());
+    }
+    return report;
+}
@@ -0,0 +1,32 @@
+#include <iostream>
+#include <string>
+#include <iomanip>
+#include "currency.h"
+#include "trace.h"
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: trace_replay <trace file> [--max-speed]\n";
+        return 2;
+    }
+    ReplaySpeed speed = ReplaySpeed::Original;
+    if (argc > 2 && std::string(argv[2]) == "--max-speed") speed = ReplaySpeed::Maximum;
+
+    CurrencyConverter converter;
+    try {
+        ReplayReport report = replayTrace(argv[1], converter, speed);
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << "Operations: " << report.operations << "\n"
+                  << "Mismatches: " << report.mismatches << "\n"
+                  << "Elapsed: " << report.seconds << " s\n"
+                  << "Throughput: " << report.operationsPerSecond << " ops/s\n"
+                  << "Latency p50: " << report.p50.count() << " ns\n"
+                  << "Latency p90: " << report.p90.count() << " ns\n"
+                  << "Latency p99: " << report.p99.count() << " ns\n"
+                  << "Latency max: " << report.max.count() << " ns\n";
+        return report.mismatches == 0 ? 0 : 1;
+    } catch (const std::exception& exception) {
+        std::cerr << "Error: " << exception.what() << "\n";
+        return 2;
+    }
+}
@@ -1,6 +1,11 @@
 #include <gtest/gtest.h>
 #include "currency.h"
 #include "currency_parser.h"
+#include <sstream>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 TEST(CryptoCurrencyTest, ConstructionAndGetters) {
     std::vector<std::string> allowed = {"United States", "Japan"};
@@ -84,6 +89,70 @@ TEST(CurrencyConverterTest, ThrowsOnUnknownCurrency) {
     EXPECT_THROW(converter.convert("EUR", "USD", 1.0), std::runtime_error);
 }
 
+TEST(CurrencyConverterTest, ListCurrenciesByTypeAndPage) {
+    CurrencyConverter converter;
+    converter.addCurrency(std::make_shared<FiatCurrency>("USD", "$", 1.0, 0.005, 0.023, std::vector<std::string>{"United States"}));
+    converter.addCurrency(std::make_shared<FiatCurrency>("EUR", "€", 1.14, 0.01, 0.019, std::vector<std::string>{"France"}));
+    converter.addCurrency(std::make_shared<FiatCurrency>("GBP", "£", 1.35, 0.01, 0.035, std::vector<std::string>{"UK"}));
+    converter.addCurrency(std::make_shared<CryptoCurrency>("BTC", "₿", 105767, 0.02, 1.35, std::vector<std::string>{"Japan"}));
+    converter.addCurrency(std::make_shared<MagicCurrency>("ARSH", "✨", 100.0, 0.05, 7, "Fireball", "Arcadia"));
+
+    const Currency* page[2];
+    ASSERT_EQ(converter.listCurrencies(page, 2), 2);
+    EXPECT_EQ(page[0]->getCode(), "BTC");
+    EXPECT_EQ(page[1]->getCode(), "EUR");
+    ASSERT_EQ(converter.listCurrencies(page, 2, "", page[1]->getCode()), 2);
+    EXPECT_EQ(page[0]->getCode(), "GBP");
+    EXPECT_EQ(page[1]->getCode(), "USD");
+    std::string cursor = page[1]->getCode();
+    converter.addCurrency(std::make_shared<FiatCurrency>("USD", "$", 1.0, 0.005, 0.023, std::vector<std::string>{"United States"}));
+    ASSERT_EQ(converter.listCurrencies(page, 2, "", cursor), 1);
+    EXPECT_EQ(page[0]->getCode(), "ARSH");
+    EXPECT_THROW(converter.listCurrencies(page, 2, "", "XYZ"), std::runtime_error);
+
+    const Currency* fiat[4];
+    ASSERT_EQ(converter.listCurrencies(fiat, 4, "Fiat"), 3);
+    EXPECT_EQ(converter.listCurrencies(fiat, 4, "fiat"), 3);
+    EXPECT_EQ(fiat[2]->getCode(), "USD");
+    EXPECT_EQ(converter.listCurrencies(fiat, 4, "Fiat", "usd"), 0);
+    EXPECT_EQ(converter.listCurrencies(fiat, 4, "Fiat", "ARSH"), 3);
+    ASSERT_EQ(converter.listCurrencies(fiat, 4, "Fiat", "EUR"), 2);
+    EXPECT_EQ(fiat[0]->getCode(), "GBP");
+}
+
+TEST(CurrencyConverterTest, FindCurrenciesByPrefix) {
+    CurrencyConverter converter;
+    converter.addCurrency(std::make_shared<FiatCurrency>("USD", "$", 1.0, 0.005, 0.023, std::vector<std::string>{"United States"}));
+    converter.addCurrency(std::make_shared<CryptoCurrency>("USDT", "₮", 1.0, 0.02, 0.05, std::vector<std::string>{"Japan"}));
+    converter.addCurrency(std::make_shared<FiatCurrency>("EUR", "€", 1.14, 0.01, 0.019, std::vector<std::string>{"France"}));
+
+    const Currency* results[4];
+    ASSERT_EQ(converter.findCurrencies(" us", results, 4), 2);
+    EXPECT_EQ(results[0]->getCode(), "USD");
+    EXPECT_EQ(results[1]->getCode(), "USDT");
+    EXPECT_EQ(converter.findCurrencies("usd", results, 1), 1);
+
+    EXPECT_EQ(converter.findCurrencies("EIR", results, 4), 0);
+    ASSERT_EQ(converter.findCurrencies("EIR", results, 4, true), 1);
+    EXPECT_EQ(results[0]->getCode(), "EUR");
+    ASSERT_EQ(converter.findCurrencies("ERU", results, 4, true), 1);
+    EXPECT_EQ(results[0]->getCode(), "EUR");
+    ASSERT_EQ(converter.findCurrencies("UDS", results, 4, true), 2);
+    EXPECT_EQ(results[0]->getCode(), "USD");
+    ASSERT_EQ(converter.findCurrencies("EURR", results, 4, true), 1);
+    EXPECT_EQ(results[0]->getCode(), "EUR");
+    ASSERT_EQ(converter.findCurrencies("SD", results, 4, true), 2);
+    EXPECT_EQ(results[0]->getCode(), "USD");
+    EXPECT_EQ(results[1]->getCode(), "USDT");
+
+    converter.addCurrency(std::make_shared<CryptoCurrency>("BTC", "₿", 105767, 0.02, 1.35, std::vector<std::string>{"Japan"}));
+    ASSERT_EQ(converter.findCurrencies("TC", results, 4, true), 1);
+    EXPECT_EQ(results[0]->getCode(), "BTC");
+
+    converter.addCurrency(std::make_shared<CryptoCurrency>("AYC", "A", 1.0, 0.02, 0.05, std::vector<std::string>{"Japan"}));
+    EXPECT_EQ(converter.findCurrencies("ACX", results, 4, true), 0);
+}
+
 TEST(FiatCurrencyTest, ApplyTaxOrFee) {
     std::vector<std::string> allowed = {"United States"};
     FiatCurrency usd("USD", "$", 1.0, 0.01, 0.02, allowed);
@@ -135,6 +204,59 @@ TEST(ParserTest, SplitCountries) {
     EXPECT_EQ(countries[1], "Canada");
 }
 
+TEST(ParserTest, StreamCurrenciesAcrossChunks) {
+    std::istringstream input(
+        "Code,Symbol,RateToUSD,TaxRate,InflationRate,allowedCountries\r\n"
+        "USD,$,1.0000,0.005,0.023,\"United States,Ecuador\"\r\n"
+        "EUR,€,1.1401,0.010,0.019,\"France,Germany\"\n"
+        "BAD,?,not-a-rate,0.01,0.01,\"Nowhere\"\n"
+        "JPY,¥,0.00690,0.010,0.036,\"Japan\"");
+    CurrencyConverter converter;
+    size_t callbacks = 0;
+    uint64_t lastBytes = 0;
+
+    LoadProgress progress = streamCurrencies(CurrencyKind::Fiat, input, converter,
+        [&](const LoadProgress& update) {
+            EXPECT_GE(update.bytes, lastBytes);
+            lastBytes = update.bytes;
+            callbacks++;
+        }, 7);
+
+    EXPECT_EQ(progress.records, 3);
+    EXPECT_EQ(progress.errors, 1);
+    EXPECT_EQ(progress.bytes, input.str().size());
+    EXPECT_GT(callbacks, 10);
+    EXPECT_DOUBLE_EQ(converter.getCurrency("JPY")->getRate(), 0.0069);
+    auto usd = std::dynamic_pointer_cast<FiatCurrency>(converter.getCurrency("USD"));
+    ASSERT_NE(usd, nullptr);
+    EXPECT_TRUE(usd->canBeUsedIn("Ecuador"));
+}
+
+TEST(ParserTest, StreamCurrenciesDropsOversizedRecords) {
+    std::string input = "Code,Symbol,RateToUSD,TaxRate,InflationRate,allowedCountries\n";
+    input += "XXX,x,1.0,0.01,0.01,\"" + std::string(200 * 1024, 'a') + "\"\n";
+    input += "JPY,¥,0.00690,0.010,0.036,\"Japan\"\n";
+    std::istringstream stream(input);
+    CurrencyConverter converter;
+
+    LoadProgress progress = streamCurrencies(CurrencyKind::Fiat, stream, converter, nullptr, 4096);
+
+    EXPECT_EQ(progress.records, 1);
+    EXPECT_EQ(progress.errors, 1);
+    EXPECT_THROW(converter.getCurrency("XXX"), std::runtime_error);
+    EXPECT_DOUBLE_EQ(converter.getCurrency("JPY")->getRate(), 0.0069);
+}
+
+#ifndef _WIN32
+TEST(ParserTest, StreamCurrenciesReportsReadErrors) {
+    int fd = open(".", O_RDONLY);
+    ASSERT_GE(fd, 0);
+    CurrencyConverter converter;
+    EXPECT_THROW(streamCurrencies(CurrencyKind::Fiat, fd, converter), std::runtime_error);
+    close(fd);
+}
+#endif
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include "currency.h"
+#include "portfolio.h"
+
+static double expectedValue(const CurrencyConverter& converter, const std::string& code,
+                            double amount, const std::string& baseCode) {
+    auto currency = converter.getCurrency(code);
+    return converter.convert(code, baseCode, amount - currency->applyTaxOrFee(amount));
+}
+
+class PortfolioTest : public ::testing::Test {
+protected:
+    CurrencyConverter converter;
+    void SetUp() override {
+        converter.addCurrency(std::make_shared<FiatCurrency>("USD", "$", 1.0, 0.005, 0.023, std::vector<std::string>{"United States"}));
+        converter.addCurrency(std::make_shared<FiatCurrency>("EUR", "€", 1.14, 0.01, 0.019, std::vector<std::string>{"France"}));
+        converter.addCurrency(std::make_shared<CryptoCurrency>("BTC", "₿", 105767, 0.02, 1.35, std::vector<std::string>{"Japan"}));
+        converter.addCurrency(std::make_shared<MagicCurrency>("ARSH", "✨", 100.0, 0.05, 7, "Fireball", "Arcadia"));
+    }
+};
+
+TEST_F(PortfolioTest, ValuesPositionsNetOfFees) {
+    Portfolio portfolio(converter, "EUR");
+    portfolio.addPosition("USD", 500);
+    portfolio.addPosition("btc", 2);
+    portfolio.addPosition("BTC", 1);
+
+    EXPECT_EQ(portfolio.getPositionCount(), 2);
+    EXPECT_DOUBLE_EQ(portfolio.getPosition("BTC"), 3);
+    EXPECT_NEAR(portfolio.getTotalValue(),
+                expectedValue(converter, "USD", 500, "EUR") + expectedValue(converter, "BTC", 3, "EUR"), 1e-6);
+    EXPECT_THROW(portfolio.addPosition("GBP", 1), std::runtime_error);
+}
+
+TEST_F(PortfolioTest, RevaluesOnlyChangedCurrencies) {
+    Portfolio crypto(converter, "USD");
+    crypto.addPosition("BTC", 1.5);
+    crypto.addPosition("ARSH", 10);
+    Portfolio fiat(converter, "BTC");
+    fiat.addPosition("EUR", 2000);
+
+    converter.applyRateUpdates({{"BTC", 90000, 1}, {"EUR", 1.2, 1}});
+    EXPECT_NEAR(crypto.getTotalValue(),
+                expectedValue(converter, "BTC", 1.5, "USD") + expectedValue(converter, "ARSH", 10, "USD"), 1e-6);
+    EXPECT_NEAR(fiat.getTotalValue(), expectedValue(converter, "EUR", 2000, "BTC"), 1e-12);
+
+    converter.fluctuateAll();
+    double incremental = crypto.getTotalValue();
+    EXPECT_NEAR(incremental, crypto.revalueAll(), 1e-6);
+}
+
+TEST_F(PortfolioTest, UnregistersOnDestruction) {
+    {
+        Portfolio shortLived(converter, "USD");
+        shortLived.addPosition("EUR", 10);
+    }
+    EXPECT_NO_THROW(converter.applyRateUpdates({{"EUR", 1.3, 1}}));
+    EXPECT_NO_THROW(converter.fluctuateAll());
+}
+
+TEST_F(PortfolioTest, FollowsReplacedCurrencies) {
+    Portfolio portfolio(converter, "EUR");
+    portfolio.addPosition("USD", 100);
+    portfolio.addPosition("BTC", 0.001);
+
+    converter.addCurrency(std::make_shared<FiatCurrency>("USD", "$", 1.0, 0.02, 0.023, std::vector<std::string>{"United States"}));
+    converter.addCurrency(std::make_shared<FiatCurrency>("EUR", "€", 1.2, 0.01, 0.019, std::vector<std::string>{"France"}));
+    converter.applyRateUpdates({{"USD", 3.0, 1}});
+
+    EXPECT_DOUBLE_EQ(portfolio.getPosition("USD"), 100);
+    EXPECT_EQ(portfolio.getPositionCount(), 2);
+    double expected = expectedValue(converter, "USD", 100, "EUR") + expectedValue(converter, "BTC", 0.001, "EUR");
+    EXPECT_NEAR(portfolio.getTotalValue(), expected, 1e-9);
+
+    converter.applyRateUpdates({{"EUR", 1.5, 2}});
+    expected = expectedValue(converter, "USD", 100, "EUR") + expectedValue(converter, "BTC", 0.001, "EUR");
+    EXPECT_NEAR(portfolio.getTotalValue(), expected, 1e-9);
+    EXPECT_NEAR(portfolio.revalueAll(), expected, 1e-9);
+}
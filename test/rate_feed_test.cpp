@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdio>
+#include <fstream>
+#include "currency.h"
+#include "rate_feed.h"
+
+static void addTestCurrencies(CurrencyConverter& converter) {
+    converter.addCurrency(std::make_shared<FiatCurrency>("USD", "$", 1.0, 0.005, 0.023, std::vector<std::string>{"United States"}));
+    converter.addCurrency(std::make_shared<FiatCurrency>("EUR", "€", 1.14, 0.01, 0.019, std::vector<std::string>{"France"}));
+    converter.addCurrency(std::make_shared<CryptoCurrency>("BTC", "₿", 105767, 0.02, 1.35, std::vector<std::string>{"Japan"}));
+}
+
+TEST(RateFeedTest, CoalescesJournalUpdatesPerBatch) {
+    std::string path = "rate_feed_test_" + std::to_string(getpid()) + ".log";
+    {
+        std::ofstream journal(path);
+        journal << "EUR,1.15,1\n"
+                << "btc,100000,1\n"
+                << "EUR,1.17,3\n"
+                << "EUR,1.16,2\n"
+                << "XYZ,2.0,4\n"
+                << "not a record\n"
+                << "# comment\n"
+                << "BTC,101000.5,5";
+    }
+    int fd = open(path.c_str(), O_RDONLY);
+    ASSERT_GE(fd, 0);
+
+    CurrencyConverter converter;
+    addTestCurrencies(converter);
+    RateFeed feed(fd, converter, 1024, std::chrono::hours(1), 16);
+    uint64_t bytesRead;
+    do {
+        bytesRead = feed.getStats().bytesRead;
+        feed.poll();
+    } while (feed.getStats().bytesRead != bytesRead);
+
+    EXPECT_EQ(feed.getPendingCount(), 2);
+    EXPECT_DOUBLE_EQ(converter.getCurrency("EUR")->getRate(), 1.14);
+    EXPECT_EQ(feed.flush(), 2);
+
+    EXPECT_DOUBLE_EQ(converter.getCurrency("EUR")->getRate(), 1.17);
+    EXPECT_DOUBLE_EQ(converter.getCurrency("BTC")->getRate(), 100000);
+
+    std::ofstream(path, std::ios::app) << "\nEUR,1.10,2\n";
+    feed.poll();
+    feed.flush();
+    EXPECT_DOUBLE_EQ(converter.getCurrency("BTC")->getRate(), 101000.5);
+    EXPECT_DOUBLE_EQ(converter.getCurrency("EUR")->getRate(), 1.17);
+
+    RateFeedStats stats = feed.getStats();
+    EXPECT_EQ(stats.records, 7);
+    EXPECT_EQ(stats.stale, 1);
+    EXPECT_EQ(stats.coalesced, 2);
+    EXPECT_EQ(stats.malformed, 1);
+    EXPECT_EQ(stats.unknown, 1);
+    EXPECT_EQ(stats.batches, 2);
+    EXPECT_EQ(stats.applied, 3);
+    EXPECT_GT(stats.recordsPerSecond, 0);
+
+    close(fd);
+    std::remove(path.c_str());
+}
+
+TEST(RateFeedTest, FlushesWhenBatchIsFull) {
+    CurrencyConverter converter;
+    addTestCurrencies(converter);
+    RateFeed feed(-1, converter, 2, std::chrono::hours(1));
+
+    std::string records = "USD,1.0,1\nEUR,1.2,1\nBTC,90000,1\n";
+    EXPECT_EQ(feed.ingest(records.data(), records.size()), 3);
+    EXPECT_DOUBLE_EQ(converter.getCurrency("EUR")->getRate(), 1.2);
+    EXPECT_EQ(feed.getPendingCount(), 1);
+    EXPECT_EQ(feed.getStats().batches, 1);
+}
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include "currency.h"
+#include "shared_rates.h"
+
+static std::string testSegmentName(const std::string& suffix) {
+    return "/currency_test_" + std::to_string(getpid()) + "_" + suffix;
+}
+
+TEST(SharedRatesTest, ViewReadsPublishedRates) {
+    std::string name = testSegmentName("rates");
+    CurrencyConverter converter;
+    converter.addCurrency(std::make_shared<FiatCurrency>("USD", "$", 1.0, 0.005, 0.023, std::vector<std::string>{"United States"}));
+    converter.addCurrency(std::make_shared<FiatCurrency>("EUR", "€", 1.14, 0.01, 0.019, std::vector<std::string>{"France"}));
+
+    SharedRatePublisher publisher(name, 16);
+    publisher.publishAll(converter);
+    SharedRateView view(name);
+
+    EXPECT_EQ(view.size(), 2);
+    EXPECT_DOUBLE_EQ(view.getRate("eur"), 1.14);
+    EXPECT_NEAR(view.convert("USD", "EUR", 10.0), converter.convert("USD", "EUR", 10.0), 1e-9);
+    EXPECT_THROW(view.getRate("GBP"), std::runtime_error);
+
+    converter.fluctuateAll();
+    publisher.publishAll(converter);
+    EXPECT_DOUBLE_EQ(view.getRate("EUR"), converter.getCurrency("EUR")->getRate());
+
+    SharedRatePublisher::remove(name);
+}
+
+TEST(SharedRatesTest, ViewDetectsPublisherRestart) {
+    std::string name = testSegmentName("restart");
+    auto publisher = std::make_unique<SharedRatePublisher>(name, 4);
+    publisher->publish("USD", 1.0);
+    publisher->publish("EUR", 1.14);
+    SharedRateView view(name);
+    uint64_t firstGeneration = view.getGeneration();
+
+    publisher.reset();
+    publisher = std::make_unique<SharedRatePublisher>(name, 4);
+    publisher->publish("EUR", 1.2);
+    EXPECT_GT(view.getGeneration(), firstGeneration);
+    EXPECT_DOUBLE_EQ(view.getRate("EUR"), 1.2);
+    EXPECT_THROW(view.getRate("USD"), std::runtime_error);
+
+    publisher.reset();
+    publisher = std::make_unique<SharedRatePublisher>(name, 8);
+    publisher->publish("GBP", 1.35);
+    EXPECT_DOUBLE_EQ(view.getRate("GBP"), 1.35);
+
+    SharedRatePublisher::remove(name);
+}
+
+TEST(SharedRatesTest, CachedIdsGoStaleOnRestart) {
+    std::string name = testSegmentName("ids");
+    auto publisher = std::make_unique<SharedRatePublisher>(name, 4);
+    publisher->publish("USD", 1.0);
+    publisher->publish("EUR", 1.14);
+    SharedRateView view(name);
+
+    uint32_t eur = view.getId("EUR");
+    uint64_t generation = view.getGeneration();
+    EXPECT_DOUBLE_EQ(view.getRateById(eur, generation), 1.14);
+
+    publisher.reset();
+    publisher = std::make_unique<SharedRatePublisher>(name, 4);
+    publisher->publish("GBP", 1.35);
+    publisher->publish("JPY", 0.0069);
+    EXPECT_THROW(view.getRateById(eur, generation), std::runtime_error);
+    EXPECT_DOUBLE_EQ(view.getRateById(view.getId("JPY"), view.getGeneration()), 0.0069);
+
+    uint32_t gbp = view.getId("GBP");
+    generation = view.getGeneration();
+    publisher.reset();
+    publisher = std::make_unique<SharedRatePublisher>(name, 8);
+    publisher->publish("CHF", 1.1);
+    publisher->publish("JPY", 0.0069);
+    EXPECT_GT(view.getGeneration(), generation);
+    EXPECT_THROW(view.getRateById(gbp, generation), std::runtime_error);
+
+    SharedRatePublisher::remove(name);
+}
@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include "currency.h"
+#include "trace.h"
+
+TEST(TraceTest, ReplayReproducesRecordedSession) {
+    std::string path = "trace_test.bin";
+    std::vector<double> recordedRates;
+    {
+        CurrencyConverter converter;
+        auto recorder = std::make_shared<TraceRecorder>(path);
+        converter.setTraceRecorder(recorder);
+        converter.addCurrency(std::make_shared<FiatCurrency>("USD", "$", 1.0, 0.005, 0.023, std::vector<std::string>{"United States"}));
+        converter.addCurrency(std::make_shared<CryptoCurrency>("BTC", "₿", 105767, 0.02, 1.35, std::vector<std::string>{"Japan"}));
+        converter.addCurrency(std::make_shared<MagicCurrency>("ARSH", "✨", 100.0, 0.05, 7, "Fireball", "Arcadia"));
+        converter.addCurrency(std::make_shared<MagicCurrency>("FRFC", "🔱", 250.5, 0.03, 3, "Frostbite", "Niflheim"));
+
+        for (int i = 0; i < 5; i++) {
+            converter.fluctuateAll();
+            converter.convert("ARSH", "USD", 10.0 + i);
+            converter.getReport("FRFC", 5.0, "earth");
+        }
+        EXPECT_THROW(converter.convert("USD", "GBP", 1.0), std::runtime_error);
+        recorder->flush();
+        EXPECT_EQ(recorder->getRecordCount(), 20);
+        recordedRates.push_back(converter.getCurrency("ARSH")->getRate());
+        recordedRates.push_back(converter.getCurrency("FRFC")->getRate());
+    }
+
+    MagicCurrency::seed(12345);
+    CurrencyConverter replayed;
+    ReplayReport report = replayTrace(path, replayed, ReplaySpeed::Maximum);
+    EXPECT_EQ(report.operations, 20);
+    EXPECT_EQ(report.mismatches, 0);
+    EXPECT_LE(report.p50, report.p99);
+    EXPECT_LE(report.p99, report.max);
+    EXPECT_DOUBLE_EQ(replayed.getCurrency("ARSH")->getRate(), recordedRates[0]);
+    EXPECT_DOUBLE_EQ(replayed.getCurrency("FRFC")->getRate(), recordedRates[1]);
+
+    std::remove(path.c_str());
+}
+
+TEST(TraceTest, ReplaysRateUpdates) {
+    std::string path = "trace_updates_test.bin";
+    {
+        CurrencyConverter converter;
+        converter.setTraceRecorder(std::make_shared<TraceRecorder>(path));
+        converter.addCurrency(std::make_shared<FiatCurrency>("USD", "$", 1.0, 0.005, 0.023, std::vector<std::string>{"United States"}));
+        converter.addCurrency(std::make_shared<FiatCurrency>("EUR", "€", 1.14, 0.01, 0.019, std::vector<std::string>{"France"}));
+        EXPECT_EQ(converter.applyRateUpdates({{"EUR", 1.5, 10}, {"GBP", 1.3, 10}}), 1);
+        converter.convert("EUR", "USD", 100.0);
+        converter.getTraceRecorder()->flush();
+    }
+
+    CurrencyConverter replayed;
+    ReplayReport report = replayTrace(path, replayed, ReplaySpeed::Maximum);
+    EXPECT_EQ(report.operations, 4);
+    EXPECT_EQ(report.mismatches, 0);
+    EXPECT_DOUBLE_EQ(replayed.getCurrency("EUR")->getRate(), 1.5);
+
+    std::remove(path.c_str());
+}
+
+TEST(TraceTest, RejectsForeignFiles) {
+    CurrencyConverter converter;
+    EXPECT_THROW(replayTrace("missing_trace.bin", converter, ReplaySpeed::Maximum), std::runtime_error);
+}